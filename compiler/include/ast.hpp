@@ -22,6 +22,10 @@ struct ASTNode {
 struct Stmt;
 struct Expr;
 
+// Expression children are shared so that hash-consed subtrees can be
+// referenced from several parents (the expression tree becomes a DAG).
+using ExprPtr = std::shared_ptr<Expr>;
+
 // Program node
 struct Program : ASTNode {
     std::vector<std::unique_ptr<ASTNode>> decls; // functions or globals
@@ -36,8 +40,19 @@ struct FunctionDecl : ASTNode {
     void dump(std::ostream &os, int indent = 0) const override;
 };
 
+struct SourcePos {
+    int line{0};
+    int column{0};
+};
+
 // Statements
-struct Stmt : ASTNode {};
+struct Stmt : ASTNode {
+    // Filled only when hash-consing: the position of every node of this
+    // statement's expression, unfolded as a tree, in post-order. Shared
+    // nodes keep their first occurrence's position; this keeps the rest so
+    // diagnostics still point at each occurrence.
+    std::vector<SourcePos> exprPositions;
+};
 
 struct BlockStmt : Stmt {
     std::vector<std::unique_ptr<Stmt>> statements;
@@ -47,17 +62,17 @@ struct BlockStmt : Stmt {
 struct VarDecl : Stmt {
     Type varType{};
     std::string name;
-    std::unique_ptr<Expr> init;
+    ExprPtr init;
     void dump(std::ostream &os, int indent = 0) const override;
 };
 
 struct ReturnStmt : Stmt {
-    std::unique_ptr<Expr> value;
+    ExprPtr value;
     void dump(std::ostream &os, int indent = 0) const override;
 };
 
 struct ExprStmt : Stmt {
-    std::unique_ptr<Expr> expr;
+    ExprPtr expr;
     void dump(std::ostream &os, int indent = 0) const override;
 };
 
@@ -68,8 +83,8 @@ enum class BinaryOp { Add, Sub, Mul, Div };
 
 struct BinaryExpr : Expr {
     BinaryOp op;
-    std::unique_ptr<Expr> left;
-    std::unique_ptr<Expr> right;
+    ExprPtr left;
+    ExprPtr right;
     void dump(std::ostream &os, int indent = 0) const override;
 };
 
@@ -11,6 +11,10 @@ class Lexer {
 public:
     explicit Lexer(const std::string &source);
     std::vector<Token> tokenize();
+    Token nextToken();
+    // Appends up to maxTokens tokens to out. Returns false once the
+    // END_OF_FILE token has been appended.
+    bool tokenizeBatch(std::vector<Token> &out, size_t maxTokens);
 
 private:
     char peek() const;
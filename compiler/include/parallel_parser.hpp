@@ -0,0 +1,25 @@
+#ifndef PARALLEL_PARSER_HPP
+#define PARALLEL_PARSER_HPP
+
+#include <memory>
+#include <vector>
+
+#include "ast.hpp"
+#include "token.hpp"
+
+namespace mylang {
+
+// Finds the first token of every top-level function by matching braces.
+// Returns false if any part of the stream has a shape the serial parser
+// could split differently, in which case starts is unspecified.
+bool scanFunctionStarts(const std::vector<Token> &tokens, std::vector<size_t> &starts);
+
+// Parses the top-level functions concurrently on up to threads workers
+// and assembles them in source order. The result is identical to
+// Parser::parseProgram; inputs the pre-scan rejects are parsed serially.
+std::unique_ptr<Program> parseProgramParallel(const std::vector<Token> &tokens,
+                                              unsigned threads, bool hashCons = false);
+
+} // namespace mylang
+
+#endif // PARALLEL_PARSER_HPP
@@ -1,6 +1,11 @@
 #ifndef PARSER_HPP
 #define PARSER_HPP
 
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
 #include "ast.hpp"
 #include "token.hpp"
 
@@ -8,13 +13,57 @@ namespace mylang {
 
 class Parser {
 public:
-    explicit Parser(const std::vector<Token> &tokens);
+    // With hashCons enabled, structurally identical expressions within a
+    // block are shared as a single canonical node. Each statement then
+    // records its expression's per-occurrence positions in exprPositions,
+    // so analysis reports the same diagnostics as without sharing.
+    explicit Parser(const std::vector<Token> &tokens, bool hashCons = false);
+
+    // Appends the next batch of tokens to its argument and returns false
+    // once the batch ending in END_OF_FILE has been delivered.
+    using TokenSource = std::function<bool(std::vector<Token> &)>;
+
+    // Streaming parser: tokens are pulled from source on demand and
+    // discarded once consumed.
+    explicit Parser(TokenSource source, bool hashCons = false);
 
     std::unique_ptr<Program> parseProgram();
+    // Parses the next top-level function, or returns null at end of input.
+    std::unique_ptr<FunctionDecl> parseNextFunction();
+    // Parses the function starting at tokens[start]. Not available on a
+    // streaming parser.
+    std::unique_ptr<FunctionDecl> parseFunctionAt(size_t start);
 
 private:
+    std::vector<Token> buffer; // token window in streaming mode
     const std::vector<Token> &tokens;
     size_t current{0};
+    size_t consumed{0}; // tokens consumed so far; unaffected by refill
+    TokenSource source;
+    bool sourceDone{false};
+
+    // Key of an expression whose children are already canonical: children
+    // compare by identity, so hashing and equality are O(1) per node. An
+    // Identifier's version is the number of declarations of its name seen
+    // so far, so a redeclaration yields a new node and every parent that
+    // referenced the old one stops matching.
+    struct ExprKey {
+        int kind;
+        std::string text;
+        size_t version;
+        const Expr *left;
+        const Expr *right;
+        bool operator==(const ExprKey &other) const;
+    };
+    struct ExprKeyHash {
+        size_t operator()(const ExprKey &key) const;
+    };
+    using InternTable = std::unordered_map<ExprKey, ExprPtr, ExprKeyHash>;
+
+    bool hashCons;
+    std::vector<InternTable> internScopes; // one table per open block
+    std::unordered_map<std::string, size_t> declCounts;
+    std::vector<SourcePos> exprPositions; // of the expression being parsed
 
     const Token &peek() const;
     const Token &previous() const;
@@ -22,6 +71,7 @@ private:
     bool check(TokenType type) const;
     const Token &advance();
     bool isAtEnd() const;
+    void refill();
 
     std::unique_ptr<FunctionDecl> parseFunction();
     std::unique_ptr<Stmt> parseStatement();
@@ -30,10 +80,16 @@ private:
     std::unique_ptr<Stmt> parseExprStmt();
     std::unique_ptr<BlockStmt> parseBlock();
     Type parseType();
-    std::unique_ptr<Expr> parseExpression();
-    std::unique_ptr<Expr> parseAdd();
-    std::unique_ptr<Expr> parseMul();
-    std::unique_ptr<Expr> parsePrimary();
+    ExprPtr parseExpression();
+    ExprPtr parseAdd();
+    ExprPtr parseMul();
+    ExprPtr parsePrimary();
+    std::vector<SourcePos> takeExprPositions();
+    ExprPtr makeLiteral(const std::string &value, int line, int column);
+    ExprPtr makeIdentifier(const Token &tok);
+    ExprPtr makeBinary(BinaryOp op, ExprPtr left, ExprPtr right, const Token &opTok);
+    template <typename Build>
+    ExprPtr intern(ExprKey key, Build build);
 };
 
 } // namespace mylang
@@ -0,0 +1,18 @@
+#ifndef PIPELINE_HPP
+#define PIPELINE_HPP
+
+#include <string>
+
+namespace mylang {
+
+// Parses and checks one function at a time on the calling thread,
+// releasing each function's tokens and AST before the next is parsed.
+bool checkStreaming(const std::string &source, bool hashCons);
+
+// Same result as checkStreaming, but the lexer, parser and analyzer run
+// concurrently on three threads connected by bounded SPSC queues.
+bool checkPipelined(const std::string &source, bool hashCons);
+
+} // namespace mylang
+
+#endif // PIPELINE_HPP
@@ -11,23 +11,65 @@ namespace mylang {
 
 class SemanticAnalyzer {
 public:
+    // With memoizeExprTypes enabled, each expression node is analyzed once
+    // and the result reused for every parent sharing that node; the
+    // diagnostics it produced are replayed at each occurrence's position.
+    explicit SemanticAnalyzer(bool memoizeExprTypes = false);
+
     bool analyze(const Program &program);
 
+    // Incremental interface for checking one function at a time:
+    // beginProgram, analyzeFunction for each function in source order,
+    // then endProgram, which reports diagnostics like analyze does. The
+    // function may be freed as soon as analyzeFunction returns.
+    void beginProgram();
+    void analyzeFunction(const FunctionDecl &fn);
+    bool endProgram();
+
 private:
-    using Scope = std::unordered_map<std::string, Type>;
-    std::vector<Scope> scopes;
+    // Flat symbol table: each name maps to its stack of live bindings, so
+    // lookup is O(1) regardless of nesting depth. Each scope records the
+    // names it declared so popScope can unwind them.
+    struct Binding {
+        size_t depth;
+        Type type;
+    };
+    std::unordered_map<std::string, std::vector<Binding>> symbols;
+    std::vector<std::vector<std::string>> scopes;
     std::vector<std::string> diagnostics;
+    bool memoizeExprTypes;
+
+    // Expressions are walked as trees in post-order; index counts the nodes
+    // of the current statement's expression visited so far and selects the
+    // occurrence's entry in Stmt::exprPositions.
+    struct ExprDiagnostic {
+        size_t index;
+        SourcePos pos; // used when the statement has no exprPositions
+        std::string message;
+    };
+    struct ExprInfo {
+        Type type;
+        size_t size; // nodes in the subtree, unfolded
+        std::vector<ExprDiagnostic> diagnostics; // index relative to subtree
+    };
+    std::unordered_map<const Expr*, ExprInfo> exprInfos;
+    const std::vector<SourcePos> *exprPositions{nullptr};
+    size_t exprIndex{0};
+    std::vector<ExprDiagnostic> exprDiagnostics; // current statement's log
 
     void pushScope();
     void popScope();
     bool lookup(const std::string &name, Type &out) const;
+    bool declare(const std::string &name, Type type);
     bool typesCompatible(Type a, Type b) const;
     void addDiagnostic(int line, int column, const std::string &msg);
 
     void analyzeProgram(const Program &program);
-    void analyzeFunction(const FunctionDecl &fn);
     void analyzeStmt(const Stmt *stmt, Type expectedReturn);
+    Type analyzeRootExpr(const Stmt &stmt, const Expr *expr, SourcePos *rootPos = nullptr);
     Type analyzeExpr(const Expr *expr);
+    Type computeExprType(const Expr *expr);
+    void addExprDiagnostic(size_t index, SourcePos pos, const std::string &msg);
 };
 
 } // namespace mylang
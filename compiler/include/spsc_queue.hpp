@@ -0,0 +1,77 @@
+#ifndef SPSC_QUEUE_HPP
+#define SPSC_QUEUE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace mylang {
+
+// Bounded lock-free ring buffer for exactly one producer thread and one
+// consumer thread. push blocks while the queue is full, which gives the
+// producer backpressure; pop blocks while it is empty. cancel makes both
+// sides return false instead, so neither can be left waiting forever.
+template <typename T>
+class SpscQueue {
+public:
+    // capacity is rounded up to a power of two.
+    explicit SpscQueue(size_t capacity) {
+        size_t size = 1;
+        while (size < capacity) size <<= 1;
+        slots.resize(size);
+        mask = size - 1;
+    }
+
+    SpscQueue(const SpscQueue &) = delete;
+    SpscQueue &operator=(const SpscQueue &) = delete;
+
+    bool tryPush(T &value) {
+        size_t t = tail.load(std::memory_order_relaxed);
+        if (t - head.load(std::memory_order_acquire) == slots.size()) return false;
+        slots[t & mask] = std::move(value);
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool tryPop(T &out) {
+        size_t h = head.load(std::memory_order_relaxed);
+        if (h == tail.load(std::memory_order_acquire)) return false;
+        out = std::move(slots[h & mask]);
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Returns false, dropping value, once the queue is cancelled.
+    bool push(T value) {
+        for (;;) {
+            if (cancelled.load(std::memory_order_acquire)) return false;
+            if (tryPush(value)) return true;
+            std::this_thread::yield();
+        }
+    }
+
+    // Returns false once the queue is cancelled.
+    bool pop(T &out) {
+        for (;;) {
+            if (cancelled.load(std::memory_order_acquire)) return false;
+            if (tryPop(out)) return true;
+            std::this_thread::yield();
+        }
+    }
+
+    // Safe to call from any thread.
+    void cancel() { cancelled.store(true, std::memory_order_release); }
+
+private:
+    std::vector<T> slots;
+    size_t mask{0};
+    alignas(64) std::atomic<size_t> head{0}; // next slot to pop
+    alignas(64) std::atomic<size_t> tail{0}; // next slot to push
+    std::atomic<bool> cancelled{false};
+};
+
+} // namespace mylang
+
+#endif // SPSC_QUEUE_HPP
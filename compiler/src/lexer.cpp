@@ -57,67 +57,64 @@ Token Lexer::makeToken(TokenType type, const std::string &lexeme, int tokLine, i
 
 std::vector<Token> Lexer::tokenize() {
     std::vector<Token> tokens;
+    while (tokenizeBatch(tokens, source.size() + 1)) {}
+    return tokens;
+}
 
-    while (current < source.size()) {
-        skipWhitespace();
-        if (current >= source.size()) break;
-        int tokLine = line;
-        int tokCol = column;
-        char c = peek();
-        size_t start = current;
-
-        if (std::isalpha(c) || c == '_') {
-            while (std::isalnum(peek()) || peek() == '_') advance();
-            std::string text = source.substr(start, current - start);
-            if (text == "int") {
-                tokens.push_back(makeToken(TokenType::KW_INT, text, tokLine, tokCol));
-            } else if (text == "float") {
-                tokens.push_back(makeToken(TokenType::KW_FLOAT, text, tokLine, tokCol));
-            } else if (text == "string") {
-                tokens.push_back(makeToken(TokenType::KW_STRING, text, tokLine, tokCol));
-            } else if (text == "void") {
-                tokens.push_back(makeToken(TokenType::KW_VOID, text, tokLine, tokCol));
-            } else if (text == "return") {
-                tokens.push_back(makeToken(TokenType::KW_RETURN, text, tokLine, tokCol));
-            } else if (text == "if") {
-                tokens.push_back(makeToken(TokenType::KW_IF, text, tokLine, tokCol));
-            } else if (text == "while") {
-                tokens.push_back(makeToken(TokenType::KW_WHILE, text, tokLine, tokCol));
-            } else {
-                tokens.push_back(makeToken(TokenType::IDENTIFIER, text, tokLine, tokCol));
-            }
-            continue;
-        }
-
-        if (std::isdigit(c)) {
-            while (std::isdigit(peek())) advance();
-            std::string text = source.substr(start, current - start);
-            tokens.push_back(makeToken(TokenType::NUMBER, text, tokLine, tokCol));
-            continue;
-        }
-
-        if (c == '"') {
-            tokens.push_back(lexString());
-            continue;
-        }
-
-        switch (advance()) {
-            case '(': tokens.push_back(makeToken(TokenType::LEFT_PAREN, "(", tokLine, tokCol)); break;
-            case ')': tokens.push_back(makeToken(TokenType::RIGHT_PAREN, ")", tokLine, tokCol)); break;
-            case '{': tokens.push_back(makeToken(TokenType::LEFT_BRACE, "{", tokLine, tokCol)); break;
-            case '}': tokens.push_back(makeToken(TokenType::RIGHT_BRACE, "}", tokLine, tokCol)); break;
-            case ';': tokens.push_back(makeToken(TokenType::SEMICOLON, ";", tokLine, tokCol)); break;
-            case '+': tokens.push_back(makeToken(TokenType::PLUS, "+", tokLine, tokCol)); break;
-            case '-': tokens.push_back(makeToken(TokenType::MINUS, "-", tokLine, tokCol)); break;
-            case '*': tokens.push_back(makeToken(TokenType::STAR, "*", tokLine, tokCol)); break;
-            case '/': tokens.push_back(makeToken(TokenType::SLASH, "/", tokLine, tokCol)); break;
-            case '=': tokens.push_back(makeToken(TokenType::EQUAL, "=", tokLine, tokCol)); break;
-            default: tokens.push_back(makeToken(TokenType::INVALID, std::string(1, c), tokLine, tokCol)); break;
-        }
+bool Lexer::tokenizeBatch(std::vector<Token> &out, size_t maxTokens) {
+    for (size_t i = 0; i < maxTokens; ++i) {
+        out.push_back(nextToken());
+        if (out.back().type == TokenType::END_OF_FILE) return false;
     }
+    return true;
+}
 
-    tokens.push_back(makeToken(TokenType::END_OF_FILE, "", line, column));
-    return tokens;
+Token Lexer::nextToken() {
+    skipWhitespace();
+    if (current >= source.size()) {
+        return makeToken(TokenType::END_OF_FILE, "", line, column);
+    }
+    int tokLine = line;
+    int tokCol = column;
+    char c = peek();
+    size_t start = current;
+
+    if (std::isalpha(c) || c == '_') {
+        while (std::isalnum(peek()) || peek() == '_') advance();
+        std::string text = source.substr(start, current - start);
+        if (text == "int") return makeToken(TokenType::KW_INT, text, tokLine, tokCol);
+        if (text == "float") return makeToken(TokenType::KW_FLOAT, text, tokLine, tokCol);
+        if (text == "string") return makeToken(TokenType::KW_STRING, text, tokLine, tokCol);
+        if (text == "void") return makeToken(TokenType::KW_VOID, text, tokLine, tokCol);
+        if (text == "return") return makeToken(TokenType::KW_RETURN, text, tokLine, tokCol);
+        if (text == "if") return makeToken(TokenType::KW_IF, text, tokLine, tokCol);
+        if (text == "while") return makeToken(TokenType::KW_WHILE, text, tokLine, tokCol);
+        return makeToken(TokenType::IDENTIFIER, text, tokLine, tokCol);
+    }
+
+    if (std::isdigit(c)) {
+        while (std::isdigit(peek())) advance();
+        std::string text = source.substr(start, current - start);
+        return makeToken(TokenType::NUMBER, text, tokLine, tokCol);
+    }
+
+    if (c == '"') {
+        return lexString();
+    }
+
+    switch (advance()) {
+        case '(': return makeToken(TokenType::LEFT_PAREN, "(", tokLine, tokCol);
+        case ')': return makeToken(TokenType::RIGHT_PAREN, ")", tokLine, tokCol);
+        case '{': return makeToken(TokenType::LEFT_BRACE, "{", tokLine, tokCol);
+        case '}': return makeToken(TokenType::RIGHT_BRACE, "}", tokLine, tokCol);
+        case ';': return makeToken(TokenType::SEMICOLON, ";", tokLine, tokCol);
+        case '+': return makeToken(TokenType::PLUS, "+", tokLine, tokCol);
+        case '-': return makeToken(TokenType::MINUS, "-", tokLine, tokCol);
+        case '*': return makeToken(TokenType::STAR, "*", tokLine, tokCol);
+        case '/': return makeToken(TokenType::SLASH, "/", tokLine, tokCol);
+        case '=': return makeToken(TokenType::EQUAL, "=", tokLine, tokCol);
+        default: return makeToken(TokenType::INVALID, std::string(1, c), tokLine, tokCol);
+    }
 }
 
 } // namespace mylang
@@ -1,30 +1,65 @@
 #include <fstream>
 #include <iostream>
 #include <sstream>
+#include <string>
+#include <thread>
 #include "lexer.hpp"
+#include "parallel_parser.hpp"
 #include "parser.hpp"
+#include "pipeline.hpp"
 
 using namespace mylang;
 
 int main(int argc, char **argv) {
-    if (argc < 2) {
-        std::cerr << "Usage: " << argv[0] << " <source file>\n";
+    bool hashCons = false;
+    bool check = false;
+    bool pipelined = false;
+    bool parallelParse = false;
+    const char *path = nullptr;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--hash-cons") {
+            // Shares identical expression subtrees (see Parser).
+            hashCons = true;
+        } else if (arg == "--check") {
+            check = true;
+        } else if (arg == "--pipeline") {
+            check = true;
+            pipelined = true;
+        } else if (arg == "--parallel-parse") {
+            parallelParse = true;
+        } else {
+            path = argv[i];
+        }
+    }
+    if (!path) {
+        std::cerr << "Usage: " << argv[0] << " [--hash-cons] [--check] [--pipeline] [--parallel-parse] <source file>\n";
         return 1;
     }
-    std::ifstream file(argv[1]);
+    std::ifstream file(path);
     if (!file) {
-        std::cerr << "Could not open file: " << argv[1] << "\n";
+        std::cerr << "Could not open file: " << path << "\n";
         return 1;
     }
     std::stringstream buffer;
     buffer << file.rdbuf();
     std::string source = buffer.str();
 
+    if (check) {
+        bool ok = pipelined ? checkPipelined(source, hashCons) : checkStreaming(source, hashCons);
+        return ok ? 0 : 1;
+    }
+
     Lexer lexer(source);
     auto tokens = lexer.tokenize();
 
-    Parser parser(tokens);
-    auto program = parser.parseProgram();
+    std::unique_ptr<Program> program;
+    if (parallelParse) {
+        program = parseProgramParallel(tokens, std::thread::hardware_concurrency(), hashCons);
+    } else {
+        Parser parser(tokens, hashCons);
+        program = parser.parseProgram();
+    }
     program->dump(std::cout);
 
     return 0;
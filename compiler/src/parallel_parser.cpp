@@ -0,0 +1,136 @@
+#include "parallel_parser.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <system_error>
+#include <thread>
+
+#include "parser.hpp"
+
+namespace mylang {
+
+static bool isTypeKeyword(TokenType type) {
+    return type == TokenType::KW_INT || type == TokenType::KW_FLOAT ||
+           type == TokenType::KW_STRING || type == TokenType::KW_VOID;
+}
+
+// Keywords that start a VarDecl, whose name is taken with an unchecked
+// advance() and so could swallow a closing brace.
+static bool startsVarDecl(TokenType type) {
+    return type == TokenType::KW_INT || type == TokenType::KW_FLOAT || type == TokenType::KW_STRING;
+}
+
+namespace {
+
+// Joins the worker threads on every exit path, so an exception on the
+// calling thread never leaves a std::thread joinable.
+class WorkerThreads {
+public:
+    WorkerThreads() = default;
+    WorkerThreads(const WorkerThreads &) = delete;
+    WorkerThreads &operator=(const WorkerThreads &) = delete;
+
+    ~WorkerThreads() { join(); }
+
+    template <typename Body>
+    void start(Body body) { threads.emplace_back(body); }
+
+    bool empty() const { return threads.empty(); }
+
+    void join() {
+        for (auto &t : threads) {
+            if (t.joinable()) t.join();
+        }
+    }
+
+private:
+    std::vector<std::thread> threads;
+};
+
+} // namespace
+
+bool scanFunctionStarts(const std::vector<Token> &tokens, std::vector<size_t> &starts) {
+    starts.clear();
+    size_t i = 0;
+    while (tokens[i].type != TokenType::END_OF_FILE) {
+        // Only the exact header "type name ( ) {" is accepted; the serial
+        // parser recovers from anything else in ways a scan cannot predict.
+        if (i + 4 >= tokens.size() ||
+            !isTypeKeyword(tokens[i].type) ||
+            tokens[i + 1].type != TokenType::IDENTIFIER ||
+            tokens[i + 2].type != TokenType::LEFT_PAREN ||
+            tokens[i + 3].type != TokenType::RIGHT_PAREN ||
+            tokens[i + 4].type != TokenType::LEFT_BRACE) {
+            return false;
+        }
+        starts.push_back(i);
+        // Find the '}' matching the header's '{'. Blocks do not nest in
+        // the grammar, so the serial parser ends the function at the first
+        // '}' and any inner '{' makes the split unpredictable.
+        size_t j = i + 5;
+        while (tokens[j].type != TokenType::RIGHT_BRACE) {
+            if (tokens[j].type == TokenType::LEFT_BRACE || tokens[j].type == TokenType::END_OF_FILE)
+                return false;
+            if (startsVarDecl(tokens[j].type) && tokens[j + 1].type == TokenType::RIGHT_BRACE)
+                return false;
+            j++;
+        }
+        i = j + 1;
+    }
+    return true;
+}
+
+std::unique_ptr<Program> parseProgramParallel(const std::vector<Token> &tokens,
+                                              unsigned threads, bool hashCons) {
+    std::vector<size_t> starts;
+    if (threads < 2 || !scanFunctionStarts(tokens, starts) || starts.size() < 2) {
+        Parser parser(tokens, hashCons);
+        return parser.parseProgram();
+    }
+
+    // Each worker parses whole functions with its own Parser, so every
+    // node of a function is allocated on the thread that parses it. The
+    // first exception a worker raises is kept and rethrown once all
+    // workers are joined; the others stop taking new functions.
+    std::vector<std::unique_ptr<FunctionDecl>> functions(starts.size());
+    std::atomic<size_t> next{0};
+    std::mutex failureMutex;
+    std::exception_ptr failure;
+    auto worker = [&]() {
+        try {
+            Parser parser(tokens, hashCons);
+            for (size_t k = next++; k < starts.size(); k = next++) {
+                functions[k] = parser.parseFunctionAt(starts[k]);
+            }
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(failureMutex);
+            if (!failure) failure = std::current_exception();
+            next = starts.size();
+        }
+    };
+
+    unsigned count = static_cast<unsigned>(std::min<size_t>(threads, starts.size()));
+    WorkerThreads pool;
+    try {
+        for (unsigned t = 1; t < count; ++t) pool.start(worker);
+    } catch (const std::system_error &) {
+        // Carry on with the threads already running; without any, the
+        // serial parser does the job.
+        if (pool.empty()) {
+            Parser parser(tokens, hashCons);
+            return parser.parseProgram();
+        }
+    }
+    worker();
+    pool.join();
+    if (failure) std::rethrow_exception(failure);
+
+    auto program = std::make_unique<Program>();
+    program->decls.reserve(functions.size());
+    for (auto &fn : functions) program->decls.push_back(std::move(fn));
+    return program;
+}
+
+} // namespace mylang
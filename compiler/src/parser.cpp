@@ -3,7 +3,30 @@
 
 namespace mylang {
 
-Parser::Parser(const std::vector<Token> &toks) : tokens(toks) {}
+Parser::Parser(const std::vector<Token> &toks, bool consExprs)
+    : tokens(toks), hashCons(consExprs) {}
+
+Parser::Parser(TokenSource src, bool consExprs)
+    : tokens(buffer), source(std::move(src)), hashCons(consExprs) {
+    refill();
+}
+
+// Drops every consumed token except the previous one and pulls the next
+// batch, so that tokens[current] is always valid.
+void Parser::refill() {
+    if (current > 0) {
+        buffer.erase(buffer.begin(), buffer.begin() + (current - 1));
+        current = 1;
+    }
+    while (current == buffer.size()) {
+        if (sourceDone || !source(buffer)) sourceDone = true;
+        if (sourceDone && current == buffer.size()) {
+            int line = buffer.empty() ? 1 : buffer.back().line;
+            int column = buffer.empty() ? 1 : buffer.back().column;
+            buffer.push_back(Token{TokenType::END_OF_FILE, "", line, column});
+        }
+    }
+}
 
 const Token &Parser::peek() const { return tokens[current]; }
 const Token &Parser::previous() const { return tokens[current - 1]; }
@@ -11,7 +34,11 @@ const Token &Parser::previous() const { return tokens[current - 1]; }
 bool Parser::isAtEnd() const { return peek().type == TokenType::END_OF_FILE; }
 
 const Token &Parser::advance() {
-    if (!isAtEnd()) current++;
+    if (!isAtEnd()) {
+        current++;
+        consumed++;
+        if (source && current == tokens.size()) refill();
+    }
     return previous();
 }
 
@@ -27,12 +54,22 @@ bool Parser::match(TokenType type) {
 
 std::unique_ptr<Program> Parser::parseProgram() {
     auto program = std::make_unique<Program>();
-    while (!isAtEnd()) {
-        program->decls.push_back(parseFunction());
+    while (auto fn = parseNextFunction()) {
+        program->decls.push_back(std::move(fn));
     }
     return program;
 }
 
+std::unique_ptr<FunctionDecl> Parser::parseNextFunction() {
+    if (isAtEnd()) return nullptr;
+    return parseFunction();
+}
+
+std::unique_ptr<FunctionDecl> Parser::parseFunctionAt(size_t start) {
+    current = start;
+    return parseFunction();
+}
+
 std::unique_ptr<FunctionDecl> Parser::parseFunction() {
     Type retType = parseType();
     Token nameTok = advance(); // identifier
@@ -53,8 +90,19 @@ std::unique_ptr<BlockStmt> Parser::parseBlock() {
     auto block = std::make_unique<BlockStmt>();
     block->line = previous().line;
     block->column = previous().column;
+    if (hashCons) internScopes.emplace_back();
     while (!check(TokenType::RIGHT_BRACE) && !isAtEnd()) {
+        size_t start = consumed;
         block->statements.push_back(parseStatement());
+        // Skip a token no statement can start with; otherwise the loop
+        // would spin on it forever.
+        if (consumed == start) advance();
+    }
+    if (hashCons) {
+        internScopes.pop_back();
+        // Versions only have to tell apart declarations within one
+        // function, so the counts start over after its outermost block.
+        if (internScopes.empty()) declCounts.clear();
     }
     match(TokenType::RIGHT_BRACE);
     return block;
@@ -78,7 +126,10 @@ std::unique_ptr<Stmt> Parser::parseStatement() {
 std::unique_ptr<Stmt> Parser::parseVarDecl() {
     Type varType = parseType();
     Token nameTok = advance(); // identifier
-    std::unique_ptr<Expr> init;
+    // A declaration rebinds its name for the rest of the block, including
+    // its own initializer.
+    if (hashCons) declCounts[nameTok.lexeme]++;
+    ExprPtr init;
     if (match(TokenType::EQUAL)) {
         init = parseExpression();
     }
@@ -89,6 +140,7 @@ std::unique_ptr<Stmt> Parser::parseVarDecl() {
     decl->varType = varType;
     decl->name = nameTok.lexeme;
     decl->init = std::move(init);
+    if (hashCons) decl->exprPositions = takeExprPositions();
     return decl;
 }
 
@@ -101,6 +153,7 @@ std::unique_ptr<Stmt> Parser::parseReturn() {
     stmt->line = tok.line;
     stmt->column = tok.column;
     stmt->value = std::move(value);
+    if (hashCons) stmt->exprPositions = takeExprPositions();
     return stmt;
 }
 
@@ -108,70 +161,55 @@ std::unique_ptr<Stmt> Parser::parseExprStmt() {
     auto expr = parseExpression();
     match(TokenType::SEMICOLON);
     auto stmt = std::make_unique<ExprStmt>();
-    stmt->line = expr ? expr->line : previous().line;
-    stmt->column = expr ? expr->column : previous().column;
+    if (hashCons) stmt->exprPositions = takeExprPositions();
+    if (!stmt->exprPositions.empty()) {
+        // A shared root carries its first occurrence's position.
+        stmt->line = stmt->exprPositions.back().line;
+        stmt->column = stmt->exprPositions.back().column;
+    } else {
+        stmt->line = expr ? expr->line : previous().line;
+        stmt->column = expr ? expr->column : previous().column;
+    }
     stmt->expr = std::move(expr);
     return stmt;
 }
 
-std::unique_ptr<Expr> Parser::parseExpression() { return parseAdd(); }
+ExprPtr Parser::parseExpression() { return parseAdd(); }
 
-std::unique_ptr<Expr> Parser::parseAdd() {
+ExprPtr Parser::parseAdd() {
     auto expr = parseMul();
     while (match(TokenType::PLUS) || match(TokenType::MINUS)) {
         Token opTok = previous();
         auto right = parseMul();
-        auto bin = std::make_unique<BinaryExpr>();
-        bin->line = opTok.line;
-        bin->column = opTok.column;
-        bin->left = std::move(expr);
-        bin->right = std::move(right);
-        bin->op = (opTok.type == TokenType::PLUS) ? BinaryOp::Add : BinaryOp::Sub;
-        expr = std::move(bin);
+        BinaryOp op = (opTok.type == TokenType::PLUS) ? BinaryOp::Add : BinaryOp::Sub;
+        expr = makeBinary(op, std::move(expr), std::move(right), opTok);
     }
     return expr;
 }
 
-std::unique_ptr<Expr> Parser::parseMul() {
+ExprPtr Parser::parseMul() {
     auto expr = parsePrimary();
     while (match(TokenType::STAR) || match(TokenType::SLASH)) {
         Token opTok = previous();
         auto right = parsePrimary();
-        auto bin = std::make_unique<BinaryExpr>();
-        bin->line = opTok.line;
-        bin->column = opTok.column;
-        bin->left = std::move(expr);
-        bin->right = std::move(right);
-        bin->op = (opTok.type == TokenType::STAR) ? BinaryOp::Mul : BinaryOp::Div;
-        expr = std::move(bin);
+        BinaryOp op = (opTok.type == TokenType::STAR) ? BinaryOp::Mul : BinaryOp::Div;
+        expr = makeBinary(op, std::move(expr), std::move(right), opTok);
     }
     return expr;
 }
 
-std::unique_ptr<Expr> Parser::parsePrimary() {
+ExprPtr Parser::parsePrimary() {
     if (match(TokenType::NUMBER)) {
-        Token tok = previous();
-        auto lit = std::make_unique<Literal>();
-        lit->line = tok.line;
-        lit->column = tok.column;
-        lit->value = tok.lexeme;
-        return lit;
+        const Token &tok = previous();
+        return makeLiteral(tok.lexeme, tok.line, tok.column);
     }
     if (match(TokenType::STRING)) {
-        Token tok = previous();
-        auto lit = std::make_unique<Literal>();
-        lit->line = tok.line;
-        lit->column = tok.column;
-        lit->value = tok.lexeme;
-        return lit;
+        const Token &tok = previous();
+        return makeLiteral(tok.lexeme, tok.line, tok.column);
     }
     if (match(TokenType::IDENTIFIER)) {
-        Token tok = previous();
-        auto id = std::make_unique<Identifier>();
-        id->line = tok.line;
-        id->column = tok.column;
-        id->name = tok.lexeme;
-        return id;
+        const Token &tok = previous();
+        return makeIdentifier(tok);
     }
     if (match(TokenType::LEFT_PAREN)) {
         auto expr = parseExpression();
@@ -179,9 +217,84 @@ std::unique_ptr<Expr> Parser::parsePrimary() {
         return expr;
     }
     // Fallback literal
-    auto invalid = std::make_unique<Literal>();
-    invalid->value = "";
-    return invalid;
+    return makeLiteral("", 0, 0);
+}
+
+bool Parser::ExprKey::operator==(const ExprKey &other) const {
+    return kind == other.kind && version == other.version && left == other.left &&
+           right == other.right && text == other.text;
+}
+
+size_t Parser::ExprKeyHash::operator()(const ExprKey &key) const {
+    size_t h = std::hash<std::string>()(key.text);
+    h = h * 31 + static_cast<size_t>(key.kind);
+    h = h * 31 + key.version;
+    h = h * 31 + std::hash<const Expr*>()(key.left);
+    h = h * 31 + std::hash<const Expr*>()(key.right);
+    return h;
+}
+
+// Returns the canonical node for key in the innermost block, calling
+// build only when no structurally identical node exists yet. Every
+// expression in the language is side-effect free, so any identical
+// subtree may be shared.
+template <typename Build>
+ExprPtr Parser::intern(ExprKey key, Build build) {
+    if (!hashCons || internScopes.empty()) return build();
+    auto &table = internScopes.back();
+    auto it = table.find(key);
+    if (it != table.end()) return it->second;
+    ExprPtr expr = build();
+    table.emplace(std::move(key), expr);
+    return expr;
+}
+
+std::vector<SourcePos> Parser::takeExprPositions() {
+    // Copy rather than move so the scratch buffer keeps its capacity.
+    std::vector<SourcePos> positions(exprPositions.begin(), exprPositions.end());
+    exprPositions.clear();
+    return positions;
+}
+
+ExprPtr Parser::makeLiteral(const std::string &value, int line, int column) {
+    if (hashCons) exprPositions.push_back(SourcePos{line, column});
+    return intern(ExprKey{0, value, 0, nullptr, nullptr}, [&]() {
+        auto lit = std::make_shared<Literal>();
+        lit->line = line;
+        lit->column = column;
+        lit->value = value;
+        return lit;
+    });
+}
+
+ExprPtr Parser::makeIdentifier(const Token &tok) {
+    size_t version = 0;
+    if (hashCons) {
+        exprPositions.push_back(SourcePos{tok.line, tok.column});
+        auto count = declCounts.find(tok.lexeme);
+        if (count != declCounts.end()) version = count->second;
+    }
+    return intern(ExprKey{1, tok.lexeme, version, nullptr, nullptr}, [&]() {
+        auto id = std::make_shared<Identifier>();
+        id->line = tok.line;
+        id->column = tok.column;
+        id->name = tok.lexeme;
+        return id;
+    });
+}
+
+ExprPtr Parser::makeBinary(BinaryOp op, ExprPtr left, ExprPtr right, const Token &opTok) {
+    if (hashCons) exprPositions.push_back(SourcePos{opTok.line, opTok.column});
+    ExprKey key{2 + static_cast<int>(op), std::string(), 0, left.get(), right.get()};
+    return intern(std::move(key), [&]() {
+        auto bin = std::make_shared<BinaryExpr>();
+        bin->line = opTok.line;
+        bin->column = opTok.column;
+        bin->left = std::move(left);
+        bin->right = std::move(right);
+        bin->op = op;
+        return bin;
+    });
 }
 
 // AST dump implementations
@@ -0,0 +1,147 @@
+#include "pipeline.hpp"
+
+#include <exception>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "lexer.hpp"
+#include "parser.hpp"
+#include "semantic_analyzer.hpp"
+#include "spsc_queue.hpp"
+
+namespace mylang {
+
+// Number of tokens the lexer hands to the parser at a time.
+static const size_t kTokenBatchSize = 256;
+static const size_t kTokenQueueCapacity = 64;
+static const size_t kFunctionQueueCapacity = 64;
+
+using TokenQueue = SpscQueue<std::vector<Token>>;
+// A null function marks the end of the program.
+using FunctionQueue = SpscQueue<std::unique_ptr<FunctionDecl>>;
+
+namespace {
+
+// Owns the stage threads of one pipeline. A stage that throws cancels
+// both queues so the other stages stop waiting, and the destructor
+// cancels and joins on every exit path, so an exception on any thread
+// never leaves a stage blocked or a std::thread joinable.
+class PipelineStages {
+public:
+    PipelineStages(TokenQueue &tokens, FunctionQueue &functions)
+        : tokenQueue(tokens), functionQueue(functions) {}
+
+    PipelineStages(const PipelineStages &) = delete;
+    PipelineStages &operator=(const PipelineStages &) = delete;
+
+    ~PipelineStages() {
+        cancel();
+        join();
+    }
+
+    template <typename Body>
+    void start(Body body) {
+        threads.emplace_back([this, body]() {
+            try {
+                body();
+            } catch (...) {
+                fail(std::current_exception());
+            }
+        });
+    }
+
+    // Joins every stage and rethrows the first exception one of them raised.
+    void finish() {
+        join();
+        if (failure) std::rethrow_exception(failure);
+    }
+
+private:
+    TokenQueue &tokenQueue;
+    FunctionQueue &functionQueue;
+    std::vector<std::thread> threads;
+    std::mutex failureMutex;
+    std::exception_ptr failure;
+
+    void cancel() {
+        tokenQueue.cancel();
+        functionQueue.cancel();
+    }
+
+    void fail(std::exception_ptr error) {
+        {
+            std::lock_guard<std::mutex> lock(failureMutex);
+            if (!failure) failure = error;
+        }
+        cancel();
+    }
+
+    void join() {
+        for (auto &t : threads) {
+            if (t.joinable()) t.join();
+        }
+    }
+};
+
+} // namespace
+
+bool checkStreaming(const std::string &source, bool hashCons) {
+    Lexer lexer(source);
+    Parser parser([&lexer](std::vector<Token> &out) {
+        return lexer.tokenizeBatch(out, kTokenBatchSize);
+    }, hashCons);
+    SemanticAnalyzer analyzer(hashCons);
+    analyzer.beginProgram();
+    while (auto fn = parser.parseNextFunction()) {
+        analyzer.analyzeFunction(*fn);
+    }
+    return analyzer.endProgram();
+}
+
+bool checkPipelined(const std::string &source, bool hashCons) {
+    TokenQueue tokenQueue(kTokenQueueCapacity);
+    FunctionQueue functionQueue(kFunctionQueueCapacity);
+    PipelineStages stages(tokenQueue, functionQueue);
+
+    stages.start([&source, &tokenQueue]() {
+        Lexer lexer(source);
+        bool more = true;
+        while (more) {
+            std::vector<Token> batch;
+            batch.reserve(kTokenBatchSize);
+            more = lexer.tokenizeBatch(batch, kTokenBatchSize);
+            if (!tokenQueue.push(std::move(batch))) return;
+        }
+    });
+
+    stages.start([hashCons, &tokenQueue, &functionQueue]() {
+        // After cancellation the source reports end of input, so the
+        // parser winds down on its own.
+        Parser parser([&tokenQueue](std::vector<Token> &out) {
+            std::vector<Token> batch;
+            if (!tokenQueue.pop(batch)) return false;
+            out.insert(out.end(), std::make_move_iterator(batch.begin()),
+                       std::make_move_iterator(batch.end()));
+            return out.back().type != TokenType::END_OF_FILE;
+        }, hashCons);
+        while (auto fn = parser.parseNextFunction()) {
+            if (!functionQueue.push(std::move(fn))) return;
+        }
+        functionQueue.push(nullptr);
+    });
+
+    SemanticAnalyzer analyzer(hashCons);
+    analyzer.beginProgram();
+    std::unique_ptr<FunctionDecl> fn;
+    while (functionQueue.pop(fn) && fn) {
+        analyzer.analyzeFunction(*fn);
+    }
+
+    stages.finish();
+    return analyzer.endProgram();
+}
+
+} // namespace mylang
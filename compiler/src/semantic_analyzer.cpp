@@ -5,16 +5,34 @@
 
 namespace mylang {
 
+SemanticAnalyzer::SemanticAnalyzer(bool memoize) : memoizeExprTypes(memoize) {}
+
 void SemanticAnalyzer::pushScope() { scopes.emplace_back(); }
 
-void SemanticAnalyzer::popScope() { if (!scopes.empty()) scopes.pop_back(); }
+void SemanticAnalyzer::popScope() {
+    if (scopes.empty()) return;
+    for (const auto &name : scopes.back()) {
+        auto it = symbols.find(name);
+        it->second.pop_back();
+        if (it->second.empty()) symbols.erase(it);
+    }
+    scopes.pop_back();
+}
 
 bool SemanticAnalyzer::lookup(const std::string &name, Type &out) const {
-    for (auto it = scopes.rbegin(); it != scopes.rend(); ++it) {
-        auto f = it->find(name);
-        if (f != it->end()) { out = f->second; return true; }
-    }
-    return false;
+    auto it = symbols.find(name);
+    if (it == symbols.end()) return false;
+    out = it->second.back().type;
+    return true;
+}
+
+// Binds name in the innermost scope; fails if it is already bound there.
+bool SemanticAnalyzer::declare(const std::string &name, Type type) {
+    auto &bindings = symbols[name];
+    if (!bindings.empty() && bindings.back().depth == scopes.size()) return false;
+    bindings.push_back(Binding{scopes.size(), type});
+    scopes.back().push_back(name);
+    return true;
 }
 
 bool SemanticAnalyzer::typesCompatible(Type a, Type b) const { return a == b; }
@@ -26,9 +44,18 @@ void SemanticAnalyzer::addDiagnostic(int line, int column, const std::string &ms
 }
 
 bool SemanticAnalyzer::analyze(const Program &program) {
+    beginProgram();
+    analyzeProgram(program);
+    return endProgram();
+}
+
+void SemanticAnalyzer::beginProgram() {
     diagnostics.clear();
+    exprInfos.clear();
     pushScope();
-    analyzeProgram(program);
+}
+
+bool SemanticAnalyzer::endProgram() {
     popScope();
 
     for (const auto &d : diagnostics) {
@@ -49,6 +76,9 @@ void SemanticAnalyzer::analyzeFunction(const FunctionDecl &fn) {
     pushScope();
     if (fn.body) analyzeStmt(fn.body.get(), fn.returnType);
     popScope();
+    // Nodes never outlive their function, and a freed node's address may
+    // be reused by the next one.
+    exprInfos.clear();
 }
 
 void SemanticAnalyzer::analyzeStmt(const Stmt *stmt, Type expectedReturn) {
@@ -57,47 +87,90 @@ void SemanticAnalyzer::analyzeStmt(const Stmt *stmt, Type expectedReturn) {
         for (const auto &s : block->statements) analyzeStmt(s.get(), expectedReturn);
         popScope();
     } else if (auto decl = dynamic_cast<const VarDecl*>(stmt)) {
-        Scope &scope = scopes.back();
-        if (scope.count(decl->name)) {
+        if (!declare(decl->name, decl->varType)) {
             addDiagnostic(decl->line, decl->column, "redefinition of variable '" + decl->name + "'");
-        } else {
-            scope[decl->name] = decl->varType;
         }
         if (decl->init) {
-            Type initType = analyzeExpr(decl->init.get());
+            SourcePos initPos;
+            Type initType = analyzeRootExpr(*decl, decl->init.get(), &initPos);
             if (!typesCompatible(decl->varType, initType)) {
-                addDiagnostic(decl->init->line, decl->init->column, "type mismatch in initialization of '" + decl->name + "'");
+                addDiagnostic(initPos.line, initPos.column, "type mismatch in initialization of '" + decl->name + "'");
             }
         }
     } else if (auto ret = dynamic_cast<const ReturnStmt*>(stmt)) {
         Type valType = Type::Void;
-        if (ret->value) valType = analyzeExpr(ret->value.get());
+        if (ret->value) valType = analyzeRootExpr(*ret, ret->value.get());
         if (!typesCompatible(expectedReturn, valType)) {
             addDiagnostic(ret->line, ret->column, "return type mismatch: expected " + std::string(typeToString(expectedReturn)));
         }
     } else if (auto exprStmt = dynamic_cast<const ExprStmt*>(stmt)) {
-        if (exprStmt->expr) analyzeExpr(exprStmt->expr.get());
+        if (exprStmt->expr) analyzeRootExpr(*exprStmt, exprStmt->expr.get());
+    }
+}
+
+// Analyzes the expression held by stmt and, if rootPos is given, stores
+// the position of its root occurrence there.
+Type SemanticAnalyzer::analyzeRootExpr(const Stmt &stmt, const Expr *expr, SourcePos *rootPos) {
+    exprPositions = stmt.exprPositions.empty() ? nullptr : &stmt.exprPositions;
+    exprIndex = 0;
+    exprDiagnostics.clear();
+    Type t = analyzeExpr(expr);
+    if (rootPos) {
+        *rootPos = exprPositions ? exprPositions->back() : SourcePos{expr->line, expr->column};
     }
+    exprPositions = nullptr;
+    return t;
 }
 
 Type SemanticAnalyzer::analyzeExpr(const Expr *expr) {
+    if (!memoizeExprTypes) return computeExprType(expr);
+    size_t base = exprIndex;
+    auto it = exprInfos.find(expr);
+    if (it != exprInfos.end()) {
+        for (const auto &d : it->second.diagnostics) {
+            addExprDiagnostic(base + d.index, d.pos, d.message);
+        }
+        exprIndex += it->second.size;
+        return it->second.type;
+    }
+    size_t logStart = exprDiagnostics.size();
+    Type t = computeExprType(expr);
+    ExprInfo info{t, exprIndex - base, {}};
+    for (size_t i = logStart; i < exprDiagnostics.size(); ++i) {
+        const auto &d = exprDiagnostics[i];
+        info.diagnostics.push_back(ExprDiagnostic{d.index - base, d.pos, d.message});
+    }
+    exprInfos.emplace(expr, std::move(info));
+    return t;
+}
+
+void SemanticAnalyzer::addExprDiagnostic(size_t index, SourcePos pos, const std::string &msg) {
+    if (exprPositions) pos = (*exprPositions)[index];
+    addDiagnostic(pos.line, pos.column, msg);
+    if (memoizeExprTypes) exprDiagnostics.push_back(ExprDiagnostic{index, pos, msg});
+}
+
+Type SemanticAnalyzer::computeExprType(const Expr *expr) {
     if (auto lit = dynamic_cast<const Literal*>(expr)) {
+        exprIndex++;
         // crude literal type detection
         bool isNumber = true;
         for (char c : lit->value) if (!std::isdigit(c)) { isNumber = false; break; }
         return isNumber ? Type::Int : Type::String;
     } else if (auto id = dynamic_cast<const Identifier*>(expr)) {
+        size_t index = exprIndex++;
         Type t{};
         if (!lookup(id->name, t)) {
-            addDiagnostic(id->line, id->column, "use of undeclared identifier '" + id->name + "'");
+            addExprDiagnostic(index, SourcePos{id->line, id->column}, "use of undeclared identifier '" + id->name + "'");
             return Type::Int;
         }
         return t;
     } else if (auto bin = dynamic_cast<const BinaryExpr*>(expr)) {
         Type left = analyzeExpr(bin->left.get());
         Type right = analyzeExpr(bin->right.get());
+        size_t index = exprIndex++;
         if (!typesCompatible(left, right)) {
-            addDiagnostic(bin->line, bin->column, "type mismatch in binary expression");
+            addExprDiagnostic(index, SourcePos{bin->line, bin->column}, "type mismatch in binary expression");
         }
         return left;
     }
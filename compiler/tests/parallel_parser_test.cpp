@@ -0,0 +1,83 @@
+// parseProgramParallel must produce exactly the Program that serial
+// parseProgram does, both for inputs the pre-scan splits across workers
+// and for inputs it rejects and hands back to the serial parser.
+
+#include <cstdio>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "lexer.hpp"
+#include "parallel_parser.hpp"
+#include "parser.hpp"
+
+using namespace mylang;
+
+namespace {
+
+const unsigned kThreads = 4;
+
+struct Input {
+    const char *name;
+    std::string source;
+    bool splittable; // expected scanFunctionStarts result
+};
+
+std::string dump(const Program &program) {
+    std::ostringstream os;
+    program.dump(os);
+    return os.str();
+}
+
+std::string manyFunctions(size_t count) {
+    std::string out;
+    for (size_t i = 0; i < count; ++i) {
+        std::string n = std::to_string(i);
+        out += "int f" + n + "() {\n int a = " + n + "; int b = a * 2 + a * 2;\n"
+               " string s = \"s" + n + "\"; b = (a + b) / (a - b);\n return a*b + a*b;\n}\n";
+        out += "void g" + n + "() { x = ) ; # return; }\n";
+    }
+    return out;
+}
+
+} // namespace
+
+int main() {
+    std::vector<Input> inputs = {
+        {"empty", "", true},
+        {"single function", "int main() { int x = 1 + 2 * 3; return x; }", true},
+        {"many functions", manyFunctions(3000), true},
+        {"bad header", manyFunctions(50) + "int broken( { return 1; }\n" + manyFunctions(50), false},
+        {"nested brace", manyFunctions(50) + "int f() { { int x = 1; } return 2; }\n" + manyFunctions(50), false},
+        {"declaration before close", manyFunctions(50) + "int f() { int }\nint g() { return 1; }\n", false},
+        {"junk at top level", manyFunctions(50) + ") ) @ # )\n" + manyFunctions(50), false},
+        {"unterminated body", manyFunctions(50) + "int f() { return 1;", false},
+    };
+
+    int failures = 0;
+    for (const auto &input : inputs) {
+        Lexer lexer(input.source);
+        auto tokens = lexer.tokenize();
+
+        std::vector<size_t> starts;
+        bool splittable = scanFunctionStarts(tokens, starts);
+        if (splittable != input.splittable) {
+            std::printf("FAIL %s: pre-scan %s the input\n", input.name,
+                        splittable ? "accepted" : "rejected");
+            failures++;
+        }
+
+        for (bool hashCons : {false, true}) {
+            Parser parser(tokens, hashCons);
+            std::string expected = dump(*parser.parseProgram());
+            std::string actual = dump(*parseProgramParallel(tokens, kThreads, hashCons));
+            if (actual != expected) {
+                std::printf("FAIL %s%s: parallel dump differs from serial\n", input.name,
+                            hashCons ? " (hash-cons)" : "");
+                failures++;
+            }
+        }
+    }
+    std::printf("%s %zu inputs\n", failures ? "FAIL" : "ok", inputs.size());
+    return failures == 0 ? 0 : 1;
+}
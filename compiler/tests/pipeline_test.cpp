@@ -0,0 +1,115 @@
+// Checks that every check mode reports exactly what the serial streaming
+// checker reports: checkPipelined must match checkStreaming, and
+// hash-consing must not change the diagnostics of either.
+
+#include <cstdio>
+#include <functional>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "pipeline.hpp"
+
+using namespace mylang;
+
+namespace {
+
+struct Result {
+    bool ok;
+    std::string diagnostics;
+};
+
+Result run(bool (*check)(const std::string &, bool), const std::string &source, bool hashCons) {
+    std::ostringstream captured;
+    std::streambuf *saved = std::cerr.rdbuf(captured.rdbuf());
+    bool ok = check(source, hashCons);
+    std::cerr.rdbuf(saved);
+    return Result{ok, captured.str()};
+}
+
+// Deterministic generator of well-formed and erroneous functions with many
+// repeated subexpressions, redeclarations and mixed types.
+std::string generated(size_t functions, unsigned seed) {
+    const char *names[] = {"a", "b", "s", "q"};
+    const char *types[] = {"int", "string", "float"};
+    const char *ops[] = {" + ", " - ", " * ", " / "};
+    auto next = [&seed]() {
+        seed = seed * 1103515245u + 12345u;
+        return (seed >> 16) & 0x7fff;
+    };
+    std::function<std::string(int)> expr = [&](int depth) -> std::string {
+        if (depth == 0 || next() % 4 == 0) {
+            unsigned pick = next() % 6;
+            if (pick < 4) return names[pick];
+            return pick == 4 ? "7" : "\"t\"";
+        }
+        std::string text = expr(depth - 1) + ops[next() % 4] + expr(depth - 1);
+        return next() % 5 == 0 ? "(" + text + ")" : text;
+    };
+    std::string out;
+    for (size_t i = 0; i < functions; ++i) {
+        out += "int f" + std::to_string(i) + "() {\n int a = 1; string s = \"x\";\n";
+        for (int k = 0; k < 12; ++k) {
+            unsigned kind = next() % 10;
+            if (kind < 2) {
+                out += std::string(" ") + types[next() % 3] + " " + names[next() % 4] + " = " + expr(3) + ";\n";
+            } else if (kind < 3) {
+                out += " return " + expr(3) + ";\n";
+            } else {
+                out += std::string(next() % 3, ' ') + expr(3) + ";\n";
+            }
+        }
+        out += "}\n";
+    }
+    return out;
+}
+
+std::string repetitive(size_t functions) {
+    std::string out;
+    for (size_t i = 0; i < functions; ++i) {
+        out += "int f" + std::to_string(i) + "() {\n int a = 1; int b = 2;\n";
+        for (int k = 0; k < 10; ++k) out += " int v" + std::to_string(k) + " = a*b + c*d;\n";
+        out += " return v1;\n}\n";
+    }
+    return out;
+}
+
+} // namespace
+
+int main() {
+    std::vector<std::pair<std::string, std::string>> inputs = {
+        {"empty", ""},
+        {"valid", "int main() { int x = 1 + 2 * 3; int y = x + x; return y; }\n"},
+        {"errors", "int main() { int x = 1; int x = 2; string s = \"a\"; int y = s + x; return z; }\n"
+                   "void h() { return; }\n"},
+        {"junk", "int main() { x = ) ; # } ) ) @ # )"},
+        {"repetitive", repetitive(300)},
+        {"generated", generated(400, 1)},
+        {"generated, other seed", generated(400, 2)},
+    };
+
+    int failures = 0;
+    for (const auto &input : inputs) {
+        Result expected = run(checkStreaming, input.second, false);
+        struct Mode {
+            const char *name;
+            bool (*check)(const std::string &, bool);
+            bool hashCons;
+        } modes[] = {
+            {"streaming, hash-cons", checkStreaming, true},
+            {"pipelined", checkPipelined, false},
+            {"pipelined, hash-cons", checkPipelined, true},
+        };
+        for (const auto &mode : modes) {
+            Result actual = run(mode.check, input.second, mode.hashCons);
+            if (actual.ok != expected.ok || actual.diagnostics != expected.diagnostics) {
+                std::printf("FAIL %s: %s differs from serial streaming check\n",
+                            input.first.c_str(), mode.name);
+                failures++;
+            }
+        }
+    }
+    std::printf("%s %zu inputs x 3 modes\n", failures ? "FAIL" : "ok", inputs.size());
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,213 @@
+// Asymptotic scaling regression suite. Each case builds one pathological
+// input shape at sizes N, 2N, 4N and 8N, times the phase it stresses and
+// fits the growth exponent (slope of log time over log size). A case
+// fails when its phase grows faster than the complexity it declares.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "lexer.hpp"
+#include "parser.hpp"
+#include "semantic_analyzer.hpp"
+
+using namespace mylang;
+
+namespace {
+
+const int kRepetitions = 5;
+const double kSlack = 0.5; // noise allowance on the fitted exponent
+const int kWatchdogSeconds = 300;
+
+using Action = std::function<void()>;
+
+struct Case {
+    const char *name;
+    double exponent; // declared complexity: time ~ size^exponent
+    size_t baseSize;
+    // Builds the input for a size outside the timed region and returns the
+    // phase to time.
+    std::function<Action(size_t)> prepare;
+};
+
+double timeAction(const Action &action) {
+    double best = 1e300;
+    for (int i = 0; i < kRepetitions; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        action();
+        auto end = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double>(end - start).count());
+    }
+    return best;
+}
+
+double fitExponent(const std::vector<double> &sizes, const std::vector<double> &times) {
+    double n = static_cast<double>(sizes.size());
+    double sx = 0, sy = 0, sxx = 0, sxy = 0;
+    for (size_t i = 0; i < sizes.size(); ++i) {
+        double x = std::log(sizes[i]);
+        double y = std::log(times[i]);
+        sx += x; sy += y; sxx += x * x; sxy += x * y;
+    }
+    return (n * sxy - sx * sy) / (n * sxx - sx * sx);
+}
+
+std::string repeat(const std::string &text, size_t count) {
+    std::string out;
+    out.reserve(text.size() * count);
+    for (size_t i = 0; i < count; ++i) out += text;
+    return out;
+}
+
+Action lexAction(std::string source) {
+    auto src = std::make_shared<std::string>(std::move(source));
+    return [src]() {
+        Lexer lexer(*src);
+        lexer.tokenize();
+    };
+}
+
+Action parseAction(const std::string &source, bool hashCons = false) {
+    Lexer lexer(source);
+    auto tokens = std::make_shared<std::vector<Token>>(lexer.tokenize());
+    return [tokens, hashCons]() {
+        Parser parser(*tokens, hashCons);
+        parser.parseProgram();
+    };
+}
+
+Action analyzeAction(std::shared_ptr<Program> program, bool memoize = false) {
+    return [program, memoize]() {
+        std::streambuf *saved = std::cerr.rdbuf(nullptr);
+        SemanticAnalyzer analyzer(memoize);
+        analyzer.analyze(*program);
+        std::cerr.rdbuf(saved);
+    };
+}
+
+std::shared_ptr<Program> parseSource(const std::string &source, bool hashCons = false) {
+    Lexer lexer(source);
+    auto tokens = lexer.tokenize();
+    Parser parser(tokens, hashCons);
+    return std::shared_ptr<Program>(parser.parseProgram());
+}
+
+std::string manyFunctions(size_t count) {
+    std::string out;
+    for (size_t i = 0; i < count; ++i) {
+        out += "int f" + std::to_string(i) + "() { int a = 1; int b = a + 2; b = a * b; return a + b; }\n";
+    }
+    return out;
+}
+
+// The grammar cannot nest blocks, so the deep-scope shape is built as an
+// AST: depth nested BlockStmts, each declaring a variable and then using
+// the outermost one, which sits depth scopes away from the use.
+std::shared_ptr<Program> deepBlocks(size_t depth) {
+    auto makeBlock = [](size_t level) {
+        auto block = std::make_unique<BlockStmt>();
+        auto decl = std::make_unique<VarDecl>();
+        decl->varType = Type::Int;
+        decl->name = "v" + std::to_string(level);
+        auto lit = std::make_shared<Literal>();
+        lit->value = "1";
+        decl->init = lit;
+        block->statements.push_back(std::move(decl));
+        auto use = std::make_unique<ExprStmt>();
+        auto id = std::make_shared<Identifier>();
+        id->name = "v0";
+        use->expr = id;
+        block->statements.push_back(std::move(use));
+        return block;
+    };
+    auto body = makeBlock(0);
+    BlockStmt *innermost = body.get();
+    for (size_t level = 1; level < depth; ++level) {
+        auto inner = makeBlock(level);
+        BlockStmt *next = inner.get();
+        innermost->statements.push_back(std::move(inner));
+        innermost = next;
+    }
+    auto fn = std::make_unique<FunctionDecl>();
+    fn->returnType = Type::Void;
+    fn->name = "deep";
+    fn->body = std::move(body);
+    auto program = std::make_shared<Program>();
+    program->decls.push_back(std::move(fn));
+    return program;
+}
+
+std::vector<Case> cases() {
+    return {
+        {"lexer: huge unterminated string", 1.0, 1 << 18, [](size_t n) {
+            return lexAction("int main() { string s = \"" + std::string(n, 'a'));
+        }},
+        {"lexer: long token stream", 1.0, 1 << 12, [](size_t n) {
+            return lexAction(repeat("x = alpha + 12 * \"s\"; ", n));
+        }},
+        {"parser: junk tokens in a body", 1.0, 1 << 11, [](size_t n) {
+            return parseAction("int main() { " + repeat(") ) @ # ) ", n) + "}");
+        }},
+        {"parser: junk tokens at top level", 1.0, 1 << 11, [](size_t n) {
+            return parseAction(repeat(") ) @ # ) ", n));
+        }},
+        {"parser: many functions", 1.0, 1 << 9, [](size_t n) {
+            return parseAction(manyFunctions(n));
+        }},
+        {"parser: many functions, hash-consed", 1.0, 1 << 9, [](size_t n) {
+            return parseAction(manyFunctions(n), true);
+        }},
+        {"analyzer: many function scopes", 1.0, 1 << 9, [](size_t n) {
+            return analyzeAction(parseSource(manyFunctions(n)));
+        }},
+        {"analyzer: many function scopes, memoized", 1.0, 1 << 9, [](size_t n) {
+            return analyzeAction(parseSource(manyFunctions(n), true), true);
+        }},
+        {"analyzer: deep block nesting", 1.0, 1 << 10, [](size_t n) {
+            return analyzeAction(deepBlocks(n));
+        }},
+        {"analyzer: undeclared identifiers", 1.0, 1 << 10, [](size_t n) {
+            return analyzeAction(parseSource("int main() { " + repeat("missing + other; ", n) + "}"));
+        }},
+    };
+}
+
+} // namespace
+
+int main() {
+    // A phase that stops terminating (as parseBlock once did on junk
+    // tokens) must fail the suite rather than hang it.
+    std::thread([]() {
+        std::this_thread::sleep_for(std::chrono::seconds(kWatchdogSeconds));
+        std::fprintf(stderr, "scaling_test: timed out after %d s\n", kWatchdogSeconds);
+        std::_Exit(1);
+    }).detach();
+
+    int failures = 0;
+    for (const auto &c : cases()) {
+        std::vector<double> sizes;
+        std::vector<double> times;
+        for (size_t factor = 1; factor <= 8; factor *= 2) {
+            size_t size = c.baseSize * factor;
+            Action action = c.prepare(size);
+            action(); // warm up
+            sizes.push_back(static_cast<double>(size));
+            times.push_back(std::max(timeAction(action), 1e-7));
+        }
+        double slope = fitExponent(sizes, times);
+        bool ok = slope <= c.exponent + kSlack;
+        if (!ok) failures++;
+        std::printf("%-4s %-42s n^%.2f (bound n^%.1f)  %.1f/%.1f/%.1f/%.1f ms\n",
+                    ok ? "ok" : "FAIL", c.name, slope, c.exponent,
+                    times[0] * 1e3, times[1] * 1e3, times[2] * 1e3, times[3] * 1e3);
+    }
+    return failures == 0 ? 0 : 1;
+}
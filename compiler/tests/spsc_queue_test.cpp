@@ -0,0 +1,73 @@
+// SpscQueue: FIFO order across threads under backpressure, and cancel
+// releasing a producer blocked on a full queue and a consumer blocked on
+// an empty one.
+
+#include <chrono>
+#include <cstdio>
+#include <thread>
+
+#include "spsc_queue.hpp"
+
+using namespace mylang;
+
+namespace {
+
+bool transfersInOrder() {
+    const int count = 200000;
+    SpscQueue<int> queue(8);
+    std::thread producer([&queue]() {
+        for (int i = 0; i < count; ++i) queue.push(i);
+    });
+    bool ordered = true;
+    for (int i = 0; i < count; ++i) {
+        int value = -1;
+        if (!queue.pop(value) || value != i) ordered = false;
+    }
+    producer.join();
+    return ordered;
+}
+
+bool cancelReleasesBlockedProducer() {
+    SpscQueue<int> queue(2);
+    queue.push(1);
+    queue.push(2);
+    bool pushed = true;
+    std::thread producer([&]() { pushed = queue.push(3); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    queue.cancel();
+    producer.join();
+    return !pushed;
+}
+
+bool cancelReleasesBlockedConsumer() {
+    SpscQueue<int> queue(2);
+    bool popped = true;
+    std::thread consumer([&]() {
+        int value = 0;
+        popped = queue.pop(value);
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    queue.cancel();
+    consumer.join();
+    return !popped;
+}
+
+} // namespace
+
+int main() {
+    struct {
+        const char *name;
+        bool (*run)();
+    } tests[] = {
+        {"transfers in order", transfersInOrder},
+        {"cancel releases blocked producer", cancelReleasesBlockedProducer},
+        {"cancel releases blocked consumer", cancelReleasesBlockedConsumer},
+    };
+    int failures = 0;
+    for (const auto &t : tests) {
+        bool ok = t.run();
+        if (!ok) failures++;
+        std::printf("%-4s %s\n", ok ? "ok" : "FAIL", t.name);
+    }
+    return failures == 0 ? 0 : 1;
+}
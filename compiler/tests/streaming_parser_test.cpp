@@ -0,0 +1,109 @@
+// A Parser fed from a TokenSource must build the Program that a Parser
+// over the whole token vector builds, whatever the batch size, and
+// checkStreaming must report what analyzing that Program reports.
+
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "lexer.hpp"
+#include "parser.hpp"
+#include "pipeline.hpp"
+#include "semantic_analyzer.hpp"
+
+using namespace mylang;
+
+namespace {
+
+const size_t kBatchSizes[] = {1, 2, 3, 256};
+
+std::string dump(const Program &program) {
+    std::ostringstream os;
+    program.dump(os);
+    return os.str();
+}
+
+// Hands out tokens[0..] batchSize at a time, like Lexer::tokenizeBatch.
+Parser::TokenSource batches(const std::vector<Token> &tokens, size_t batchSize) {
+    size_t next = 0;
+    return [&tokens, batchSize, next](std::vector<Token> &out) mutable {
+        size_t end = std::min(tokens.size(), next + batchSize);
+        out.insert(out.end(), tokens.begin() + next, tokens.begin() + end);
+        next = end;
+        return next < tokens.size();
+    };
+}
+
+struct Result {
+    bool ok;
+    std::string diagnostics;
+};
+
+template <typename Check>
+Result captureCerr(Check check) {
+    std::ostringstream captured;
+    std::streambuf *saved = std::cerr.rdbuf(captured.rdbuf());
+    bool ok = check();
+    std::cerr.rdbuf(saved);
+    return Result{ok, captured.str()};
+}
+
+std::string manyFunctions(size_t count) {
+    std::string out;
+    for (size_t i = 0; i < count; ++i) {
+        std::string n = std::to_string(i);
+        out += "int f" + n + "() {\n int a = " + n + "; int b = a * 2 + a * 2;\n"
+               " { string s = \"s" + n + "\"; b = (a + b) / (a - s); }\n return a*b + a*b;\n}\n";
+        out += "void g" + n + "() { int a = 1; x = ) ; # return a; }\n";
+    }
+    return out;
+}
+
+} // namespace
+
+int main() {
+    std::vector<std::pair<std::string, std::string>> inputs = {
+        {"empty", ""},
+        {"valid", "int main() { int x = 1 + 2 * 3; int y = x + x; return y; }\n"},
+        {"errors", "int main() { int x = 1; int x = 2; string s = \"a\"; int y = s + x; return z; }\n"
+                   "void h() { return; }\n"},
+        {"junk", "int main() { x = ) ; # } ) ) @ # )"},
+        {"unterminated", "int main() { int x = 1; return x"},
+        {"many functions", manyFunctions(200)},
+    };
+
+    int failures = 0;
+    for (const auto &input : inputs) {
+        Lexer lexer(input.second);
+        auto tokens = lexer.tokenize();
+
+        for (bool hashCons : {false, true}) {
+            Parser whole(tokens, hashCons);
+            auto program = whole.parseProgram();
+            std::string expected = dump(*program);
+            for (size_t batchSize : kBatchSizes) {
+                Parser streamed(batches(tokens, batchSize), hashCons);
+                if (dump(*streamed.parseProgram()) != expected) {
+                    std::printf("FAIL %s%s: batches of %zu dump differently\n", input.first.c_str(),
+                                hashCons ? " (hash-cons)" : "", batchSize);
+                    failures++;
+                }
+            }
+        }
+
+        Parser whole(tokens);
+        auto program = whole.parseProgram();
+        Result expected = captureCerr([&program]() { return SemanticAnalyzer().analyze(*program); });
+        Result actual = captureCerr([&input]() { return checkStreaming(input.second, false); });
+        if (actual.ok != expected.ok || actual.diagnostics != expected.diagnostics) {
+            std::printf("FAIL %s: checkStreaming differs from analyzing the whole program\n",
+                        input.first.c_str());
+            failures++;
+        }
+    }
+    std::printf("%s %zu inputs\n", failures ? "FAIL" : "ok", inputs.size());
+    return failures == 0 ? 0 : 1;
+}